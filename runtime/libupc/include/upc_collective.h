@@ -201,4 +201,19 @@ extern void upc_all_sort (shared void *A, size_t elem_size,
 			  int (*func) (shared void *, shared void *),
 			  upc_flag_t sync_mode);
 
+/* Comparison functions for upc_all_sort on arrays of built-in types.
+   When one of these is passed as 'func', upc_all_sort compares
+   the keys directly and does not call the function.  */
+extern int upc_coll_sort_cmpC (shared void *, shared void *);
+extern int upc_coll_sort_cmpUC (shared void *, shared void *);
+extern int upc_coll_sort_cmpS (shared void *, shared void *);
+extern int upc_coll_sort_cmpUS (shared void *, shared void *);
+extern int upc_coll_sort_cmpI (shared void *, shared void *);
+extern int upc_coll_sort_cmpUI (shared void *, shared void *);
+extern int upc_coll_sort_cmpL (shared void *, shared void *);
+extern int upc_coll_sort_cmpUL (shared void *, shared void *);
+extern int upc_coll_sort_cmpF (shared void *, shared void *);
+extern int upc_coll_sort_cmpD (shared void *, shared void *);
+extern int upc_coll_sort_cmpLD (shared void *, shared void *);
+
 #endif /* !_UPC_COLLECTIVE_H_ */
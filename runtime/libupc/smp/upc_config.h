@@ -191,12 +191,55 @@ typedef unsigned int upc_page_num_t;
 
 /* a value used to tag each heap allocated item, checked by upc_free */
 #define GUPCR_HEAP_ALLOC_TAG 0x0DDF00D
+
+/* a value used to tag each free heap item held in a size class index */
+#define GUPCR_HEAP_FREE_TAG 0x0F4EE0D
+
+/* Allocations of at most this many bytes (including heap overhead)
+   are served from per-thread caches of fixed size blocks.  */
+#define GUPCR_HEAP_CACHE_MAX_SIZE 1024
+
+/* Number of blocks carved at once when a per-thread cache is empty */
+#define GUPCR_HEAP_CACHE_BATCH 16
+
+/* Max. number of blocks held in each per-thread cache */
+#define GUPCR_HEAP_CACHE_LIMIT 64
 //end lib_config_heap
 
+/* Non-blocking transfers of at least this many bytes are handed
+   to the copy-offload engine; smaller transfers are completed
+   before the upc_mem*_nb() call returns.  */
+#define GUPCR_NB_OFFLOAD_MIN_DEFAULT (64*KILOBYTE)
+
+/* Default number of copy-offload helper threads per process.
+   Zero disables the offload engine.  */
+#define GUPCR_NB_HELPERS_DEFAULT 1
+
+/* Maximum number of helper threads that may be requested.  */
+#define GUPCR_NB_HELPERS_MAX 16
+
+/* Offloaded transfers are split into segments of at most this
+   size, so that several helpers (and a thread waiting in
+   upc_sync) can work on the same large transfer.  */
+#define GUPCR_NB_SEG_SIZE (1*MEGABYTE)
+
+/* Maximum number of outstanding explicit handle transfers
+   per UPC thread.  Further transfers complete at issue time.  */
+#define GUPCR_NB_MAX_OUTSTANDING 256
+
+/* Number of copy-offload helper threads, via this environment variable.  */
+#define GUPCR_NB_HELPERS_ENV "UPC_NB_HELPERS"
+
+/* Minimum offloaded transfer size, via this environment variable.  */
+#define GUPCR_NB_OFFLOAD_MIN_ENV "UPC_NB_OFFLOAD_MIN"
+
 /* By default we let kernel schedule threads */
 #define GUPCR_SCHED_POLICY_DEFAULT GUPCR_SCHED_POLICY_AUTO
 #define GUPCR_MEM_POLICY_DEFAULT GUPCR_MEM_POLICY_AUTO
 
+/* By default the barrier tree follows the NUMA node topology */
+#define GUPCR_BARRIER_SHAPE_DEFAULT GUPCR_BARRIER_SHAPE_NODE
+
 /* Enable GUM debug support via this environment variable.  */
 #define GUM_DEBUG_ENV "GUM_DEBUG"
 
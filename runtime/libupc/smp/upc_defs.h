@@ -81,6 +81,15 @@ enum upc_mem_policy_enum
   };
 typedef enum upc_mem_policy_enum upc_mem_policy_t;
 
+/* barrier shapes */
+enum upc_barrier_shape_enum
+  {
+    GUPCR_BARRIER_SHAPE_FLAT,	/* all threads notify thread 0 */
+    GUPCR_BARRIER_SHAPE_TREE,	/* tree over thread numbers */
+    GUPCR_BARRIER_SHAPE_NODE	/* tree per NUMA node, then across nodes */
+  };
+typedef enum upc_barrier_shape_enum upc_barrier_shape_t;
+
 /* Data structure used keep track of cpu's that must ba avoided */
 typedef struct upc_cpu_avoid_struct upc_cpu_avoid_t;
 typedef upc_cpu_avoid_t *upc_cpu_avoid_p;
@@ -107,6 +116,8 @@ typedef struct upc_info_struct
     int num_nodes;
     upc_sched_policy_t sched_policy;
     upc_mem_policy_t mem_policy;
+    upc_barrier_shape_t barrier_shape;
+    int barrier_fanout;
   } upc_info_t;
 typedef upc_info_t *upc_info_p;
 
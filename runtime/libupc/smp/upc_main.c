@@ -83,6 +83,12 @@ static upc_sched_policy_t __upc_sched_policy = GUPCR_SCHED_POLICY_DEFAULT;
 /* CPU memory affinity policy */
 static upc_mem_policy_t __upc_mem_policy = GUPCR_MEM_POLICY_DEFAULT;
 
+/* Barrier tree shape */
+static upc_barrier_shape_t __upc_barrier_shape = GUPCR_BARRIER_SHAPE_DEFAULT;
+
+/* Barrier tree fan-out */
+static int __upc_barrier_fanout = GUPCR_TREE_FANOUT;
+
 /* list of CPU's that must be avoided */
 static upc_cpu_avoid_p __upc_cpu_avoid_set;
 
@@ -106,6 +112,8 @@ static upc_dbg_shared_ptr_t dbg_shared_ptr __attribute__ ((__unused__));
   (!strcmp (STR, "-n") || !strcmp(STR, "-heap") \
   || !strcmp (STR, "-sched-policy") \
   || !strcmp (STR, "-mem-policy") \
+  || !strcmp (STR, "-barrier") \
+  || !strcmp (STR, "-barrier-fanout") \
   || !strcmp (STR, "-sched-cpu-avoid"))
 
 static int
@@ -227,6 +235,19 @@ __upc_print_help_and_exit (char *pgm)
       fprintf (stderr,
 	       "	                                  	  strict - only allocate on local node\n");
     }
+  fprintf (stderr,
+	   "	-barrier [node,tree,flat]		UPC barrier shape\n");
+  fprintf (stderr,
+	   "	 					  node - tree per NUMA node, then across nodes\n");
+  fprintf (stderr,
+	   "	                                      	  tree - tree over thread numbers\n");
+  fprintf (stderr,
+	   "	                                      	  flat - all threads notify thread 0\n");
+  fprintf (stderr,
+	   "	-barrier-fanout N			N is the barrier tree fan-out\n");
+  fprintf (stderr,
+	   "						(N must be in the range 2..%d)\n",
+	   GUPCR_THREADS_MAX);
   fprintf (stderr,
 	   "	-g                                  	Turn on UPC source code debugging\n");
 
@@ -416,6 +437,41 @@ __upc_process_switches (char *pgm, int *argc, char *argv[])
 	    }
 	  __upc_shift_args (argc, argv);
 	}
+      else if (!strcmp (arg, "-barrier"))
+	{
+	  tval = argv[2];
+	  if (!strcmp (tval, "node"))
+	    {
+	      __upc_barrier_shape = GUPCR_BARRIER_SHAPE_NODE;
+	    }
+	  else if (!strcmp (tval, "tree"))
+	    {
+	      __upc_barrier_shape = GUPCR_BARRIER_SHAPE_TREE;
+	    }
+	  else if (!strcmp (tval, "flat"))
+	    {
+	      __upc_barrier_shape = GUPCR_BARRIER_SHAPE_FLAT;
+	    }
+	  else
+	    {
+	      fprintf (stderr, "Invalid barrier shape specified\n");
+	      __upc_print_help_and_exit (pgm);
+	    }
+	  __upc_shift_args (argc, argv);
+	}
+      else if (!strcmp (arg, "-barrier-fanout"))
+	{
+	  long int fanout_value;
+	  tval = argv[2];
+	  if (!__upc_get_int_value (tval, &fanout_value, 0,
+				    2L, (long int) GUPCR_THREADS_MAX))
+	    {
+	      fprintf (stderr, "Invalid barrier fan-out value\n");
+	      __upc_print_help_and_exit (pgm);
+	    }
+	  __upc_barrier_fanout = (int) fanout_value;
+	  __upc_shift_args (argc, argv);
+	}
       else if (!strcmp (arg, "-sched-cpu-avoid"))
 	{
 	  if (!__upc_affinity_supported ())
@@ -537,6 +593,8 @@ __upc_init (char *pgm, const char **err_msg)
   u->num_nodes = 1;
   u->sched_policy = __upc_sched_policy;
   u->mem_policy = __upc_mem_policy;
+  u->barrier_shape = __upc_barrier_shape;
+  u->barrier_fanout = __upc_barrier_fanout;
 
   /* MPIR_partial_attach_ok support.  */
   if (MPIR_being_debugged)
@@ -583,6 +641,39 @@ __upc_init (char *pgm, const char **err_msg)
   return u;
 }
 
+/* Return the fan-out of the barrier tree.  A flat barrier
+   is a tree of depth one.  */
+
+int
+__upc_barrier_get_fanout (void)
+{
+  const upc_info_p u = __upc_info;
+  if (u->barrier_shape == GUPCR_BARRIER_SHAPE_FLAT)
+    return (THREADS > 2) ? THREADS : 2;
+  return u->barrier_fanout;
+}
+
+/* Return the barrier domain of THREAD.  Threads within the same
+   domain are combined first, and the domain roots then combine
+   across domains.  For the 'node' shape, a domain is the NUMA
+   node that THREAD's memory is bound to.  If no memory affinity
+   was assigned, the threads are assumed to be spread over the
+   nodes in blocks of consecutive thread numbers.  */
+
+int
+__upc_barrier_get_domain (int thread)
+{
+  const upc_info_p u = __upc_info;
+  const int mem_affinity = u->thread_info[thread].mem_affinity;
+  if (u->barrier_shape != GUPCR_BARRIER_SHAPE_NODE)
+    return 0;
+  if (mem_affinity >= 0)
+    return mem_affinity;
+  if (u->num_nodes > 1)
+    return (int) (((long int) thread * u->num_nodes) / THREADS);
+  return 0;
+}
+
 /* Per thread initialization.  The VM system has to be initialized
    in each thread, because it maintains a record of locally
    mapped memory regions.  Further, for thread 0, the initial
@@ -0,0 +1,505 @@
+/*===-- upc_nb_sup.c - UPC Runtime Support Library -----------------------===
+|*
+|*                     The LLVM Compiler Infrastructure
+|*
+|* Copyright 2014, Intrepid Technology, Inc.  All rights reserved.
+|* This file is distributed under a BSD-style Open Source License.
+|* See LICENSE-INTREPID.TXT for details.
+|*
+|*===---------------------------------------------------------------------===*/
+
+#include "upc_config.h"
+#include "upc_sysdep.h"
+#include "upc_defs.h"
+#include "upc_sup.h"
+#include "upc_sync.h"
+#include "upc_mem.h"
+#include "upc_nb_sup.h"
+
+/* Non-blocking transfers in the SMP runtime.
+
+   All UPC threads in a process share a copy-offload engine:
+   a FIFO queue of transfer segments and a small pool of helper
+   threads that execute them.  A segment describes a contiguous
+   copy (or set) between two addresses that are already mapped
+   into the process, so the helper threads never call into the
+   VM layer; the issuing thread performs all address translation
+   before the segment is queued.  Should the issuing thread later
+   have to unmap a global page (see __upc_vm_map_global_page),
+   it first waits for its outstanding segments via
+   __upc_nb_quiesce.
+
+   Each UPC thread owns a table of explicit handle control blocks.
+   A handle value selects its table slot (handle modulo the
+   table size) and is checked against the value stored there,
+   so stale or invalid handles are detected.  Each control block
+   counts the segments of its transfer that are not yet complete.
+   Implicit handle transfers share a single per-thread counter.
+
+   Threads waiting in upc_sync/upc_synci (or polling via
+   upc_sync_attempt/upc_synci_attempt) execute queued segments
+   themselves rather than idle, so a transfer always makes
+   progress even if all helpers are busy.  Transfers smaller than
+   the offload threshold, or issued when the handle table is full
+   or the engine is disabled, complete before the call returns
+   and yield UPC_COMPLETE_HANDLE.  */
+
+typedef enum
+  {
+    UPC_NB_OP_COPY,
+    UPC_NB_OP_SET
+  } upc_nb_op_t;
+
+/* Queued transfer segment.  */
+typedef struct upc_nb_seg_struct
+  {
+    struct upc_nb_seg_struct *next;
+    upc_nb_op_t op;
+    void *dest;
+    const void *src;
+    int c;
+    size_t n;
+    os_atomic_p counter;	/* Transfer's pending segment count.  */
+    os_atomic_p outstanding;	/* Issuing thread's pending segment count.  */
+  } upc_nb_seg_t;
+typedef upc_nb_seg_t *upc_nb_seg_p;
+
+/* Explicit handle control block.  A zero handle marks a free entry.  */
+typedef struct upc_nb_req_struct
+  {
+    unsigned long handle;
+    os_atomic_t pending;
+  } upc_nb_req_t;
+typedef upc_nb_req_t *upc_nb_req_p;
+
+/* Offload engine state, shared by all UPC threads in this process.  */
+static pthread_once_t __upc_nb_once = PTHREAD_ONCE_INIT;
+static pthread_mutex_t __upc_nb_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t __upc_nb_cond = PTHREAD_COND_INITIALIZER;
+static upc_nb_seg_p volatile __upc_nb_queue_head;
+static upc_nb_seg_p __upc_nb_queue_tail;
+static upc_nb_seg_p __upc_nb_seg_free;
+static int __upc_nb_helpers;
+static size_t __upc_nb_offload_min;
+
+/* Per-thread handle table and pending segment counts.  */
+static GUPCR_THREAD_LOCAL upc_nb_req_t
+  __upc_nb_req[GUPCR_NB_MAX_OUTSTANDING];
+static GUPCR_THREAD_LOCAL unsigned long __upc_nb_handle_next;
+static GUPCR_THREAD_LOCAL os_atomic_t __upc_nbi_pending;
+static GUPCR_THREAD_LOCAL os_atomic_t __upc_nb_outstanding;
+
+/* Return the value of the environment variable 'name',
+   or 'dflt' if it is not set.  A 'K' or 'M' suffix
+   is accepted.  */
+
+static long int
+__upc_nb_env_value (const char *name, long int dflt,
+		    long int low, long int high)
+{
+  const char *env = getenv (name);
+  char *end;
+  long int v;
+  if (!env || !*env)
+    return dflt;
+  v = strtol (env, &end, 10);
+  if (*end == 'k' || *end == 'K')
+    v *= KILOBYTE, ++end;
+  else if (*end == 'm' || *end == 'M')
+    v *= MEGABYTE, ++end;
+  if (*end || v < low || v > high)
+    __upc_fatal ("Invalid %s value: %s", name, env);
+  return v;
+}
+
+/* The following queue routines must be called
+   with the engine mutex held.  */
+
+static upc_nb_seg_p
+__upc_nb_seg_alloc (void)
+{
+  upc_nb_seg_p seg = __upc_nb_seg_free;
+  if (seg)
+    __upc_nb_seg_free = seg->next;
+  else
+    {
+      seg = malloc (sizeof (upc_nb_seg_t));
+      if (!seg)
+	__upc_fatal ("UPC non-blocking transfer: out of memory");
+    }
+  return seg;
+}
+
+static upc_nb_seg_p
+__upc_nb_dequeue (void)
+{
+  upc_nb_seg_p seg = __upc_nb_queue_head;
+  if (seg)
+    {
+      __upc_nb_queue_head = seg->next;
+      if (!seg->next)
+	__upc_nb_queue_tail = NULL;
+    }
+  return seg;
+}
+
+/* Perform the transfer described by 'seg', recycle it,
+   and then signal its completion.  */
+
+static void
+__upc_nb_execute (upc_nb_seg_p seg)
+{
+  const os_atomic_p counter = seg->counter;
+  const os_atomic_p outstanding = seg->outstanding;
+  if (seg->op == UPC_NB_OP_COPY)
+    memcpy (seg->dest, seg->src, seg->n);
+  else
+    memset (seg->dest, seg->c, seg->n);
+  pthread_mutex_lock (&__upc_nb_mutex);
+  seg->next = __upc_nb_seg_free;
+  __upc_nb_seg_free = seg;
+  pthread_mutex_unlock (&__upc_nb_mutex);
+  GUPCR_WRITE_FENCE ();
+  (void) __upc_sync_fetch_and_add (outstanding, -1);
+  (void) __upc_sync_fetch_and_add (counter, -1);
+}
+
+/* Helper thread main loop.  Signals are left
+   to the UPC thread(s) of this process.  */
+
+static void *
+__upc_nb_helper (void *arg __attribute__ ((unused)))
+{
+  sigset_t mask;
+  sigfillset (&mask);
+  pthread_sigmask (SIG_BLOCK, &mask, NULL);
+  for (;;)
+    {
+      upc_nb_seg_p seg;
+      pthread_mutex_lock (&__upc_nb_mutex);
+      while (!(seg = __upc_nb_dequeue ()))
+	pthread_cond_wait (&__upc_nb_cond, &__upc_nb_mutex);
+      pthread_mutex_unlock (&__upc_nb_mutex);
+      __upc_nb_execute (seg);
+    }
+  return NULL;
+}
+
+/* Start the helper threads.  This is done on first use,
+   after the UPC threads have been created, so that
+   helpers are never duplicated by fork().  */
+
+static void
+__upc_nb_engine_init (void)
+{
+  const long int dflt_helpers = (__upc_num_cpus > 1)
+				? GUPCR_NB_HELPERS_DEFAULT : 0;
+  const long int helpers = __upc_nb_env_value (GUPCR_NB_HELPERS_ENV,
+					       dflt_helpers, 0,
+					       GUPCR_NB_HELPERS_MAX);
+  pthread_attr_t attr;
+  int i;
+  __upc_nb_offload_min = (size_t)
+    __upc_nb_env_value (GUPCR_NB_OFFLOAD_MIN_ENV,
+			GUPCR_NB_OFFLOAD_MIN_DEFAULT, 0,
+			GUPCR_MAX_HEAP_SIZE);
+  pthread_attr_init (&attr);
+  pthread_attr_setdetachstate (&attr, PTHREAD_CREATE_DETACHED);
+  for (i = 0; i < helpers; ++i)
+    {
+      pthread_t id;
+      /* Run with fewer helpers if one cannot be created.  */
+      if (pthread_create (&id, &attr, __upc_nb_helper, NULL))
+	break;
+    }
+  pthread_attr_destroy (&attr);
+  __upc_nb_helpers = i;
+}
+
+/* Return TRUE if a transfer of 'n' bytes should be
+   handed to the offload engine.  */
+
+static int
+__upc_nb_offload_p (size_t n)
+{
+  pthread_once (&__upc_nb_once, __upc_nb_engine_init);
+  return __upc_nb_helpers > 0 && n && n >= __upc_nb_offload_min;
+}
+
+/* Select the completion counter of a new transfer.  For an
+   explicit handle transfer, a control block is allocated and
+   its handle is returned via 'handle'.  NULL is returned if
+   the handle table is full.  */
+
+static os_atomic_p
+__upc_nb_counter (int implicit, unsigned long *handle)
+{
+  int i;
+  *handle = 0;
+  if (implicit)
+    return &__upc_nbi_pending;
+  for (i = 0; i < GUPCR_NB_MAX_OUTSTANDING; ++i)
+    {
+      const unsigned long h = ++__upc_nb_handle_next;
+      const upc_nb_req_p r = &__upc_nb_req[h % GUPCR_NB_MAX_OUTSTANDING];
+      if (!r->handle)
+	{
+	  r->handle = h;
+	  r->pending = 0;
+	  *handle = h;
+	  return &r->pending;
+	}
+    }
+  return NULL;
+}
+
+/* Queue a transfer between mapped addresses,
+   split into segments of at most GUPCR_NB_SEG_SIZE.  */
+
+static void
+__upc_nb_offload (upc_nb_op_t op, char *dest, const char *src, int c,
+		  size_t n, os_atomic_p counter)
+{
+  while (n)
+    {
+      const size_t n_seg = GUPCR_MIN (n, GUPCR_NB_SEG_SIZE);
+      upc_nb_seg_p seg;
+      (void) __upc_sync_fetch_and_add (counter, 1);
+      (void) __upc_sync_fetch_and_add (&__upc_nb_outstanding, 1);
+      pthread_mutex_lock (&__upc_nb_mutex);
+      seg = __upc_nb_seg_alloc ();
+      seg->next = NULL;
+      seg->op = op;
+      seg->dest = dest;
+      seg->src = src;
+      seg->c = c;
+      seg->n = n_seg;
+      seg->counter = counter;
+      seg->outstanding = &__upc_nb_outstanding;
+      if (__upc_nb_queue_tail)
+	__upc_nb_queue_tail->next = seg;
+      else
+	__upc_nb_queue_head = seg;
+      __upc_nb_queue_tail = seg;
+      pthread_cond_signal (&__upc_nb_cond);
+      pthread_mutex_unlock (&__upc_nb_mutex);
+      dest += n_seg;
+      if (src)
+	src += n_seg;
+      n -= n_seg;
+    }
+}
+
+/* Wait for 'counter' to drop to zero, executing
+   queued segments while waiting.  */
+
+static void
+__upc_nb_wait (os_atomic_p counter)
+{
+  while (*counter)
+    {
+      if (!__upc_nb_progress ())
+	__upc_spin_until (!*counter || __upc_nb_queue_head);
+    }
+  GUPCR_READ_FENCE ();
+}
+
+static upc_nb_req_p
+__upc_nb_req_lookup (unsigned long handle)
+{
+  const upc_nb_req_p r = &__upc_nb_req[handle % GUPCR_NB_MAX_OUTSTANDING];
+  if (r->handle != handle)
+    __upc_fatal ("Invalid non-blocking transfer handle: %lu", handle);
+  return r;
+}
+
+unsigned long
+__upc_nb_copy (upc_shared_ptr_t dest, upc_shared_ptr_t src,
+	       size_t n, int implicit)
+{
+  unsigned long handle;
+  os_atomic_p counter;
+  if (!__upc_nb_offload_p (n)
+      || !(counter = __upc_nb_counter (implicit, &handle)))
+    {
+      __upc_memcpy (dest, src, n);
+      return 0;
+    }
+  if (GUPCR_PTS_IS_NULL (src))
+    __upc_fatal ("Invalid access via null shared pointer");
+  if (GUPCR_PTS_IS_NULL (dest))
+    __upc_fatal ("Invalid access via null shared pointer");
+  for (;;)
+    {
+      char *srcp = (char *)__upc_sptr_to_addr (src);
+      size_t ps_offset = GUPCR_PTS_OFFSET (src) & GUPCR_VM_OFFSET_MASK;
+      size_t ns_copy = GUPCR_VM_PAGE_SIZE - ps_offset;
+      char *destp = (char *)__upc_sptr_to_addr (dest);
+      size_t pd_offset = GUPCR_PTS_OFFSET (dest) & GUPCR_VM_OFFSET_MASK;
+      size_t nd_copy = GUPCR_VM_PAGE_SIZE - pd_offset;
+      size_t n_copy = GUPCR_MIN (GUPCR_MIN (ns_copy, nd_copy), n);
+      __upc_nb_offload (UPC_NB_OP_COPY, destp, srcp, 0, n_copy, counter);
+      n -= n_copy;
+      if (!n)
+	break;
+      GUPCR_PTS_INCR_VADDR (src, n_copy);
+      GUPCR_PTS_INCR_VADDR (dest, n_copy);
+    }
+  return handle;
+}
+
+unsigned long
+__upc_nb_get (void *dest, upc_shared_ptr_t src, size_t n, int implicit)
+{
+  unsigned long handle;
+  os_atomic_p counter;
+  if (!__upc_nb_offload_p (n)
+      || !(counter = __upc_nb_counter (implicit, &handle)))
+    {
+      __upc_memget (dest, src, n);
+      return 0;
+    }
+  if (!dest)
+    __upc_fatal ("Invalid access via null shared pointer");
+  if (GUPCR_PTS_IS_NULL (src))
+    __upc_fatal ("Invalid access via null shared pointer");
+  for (;;)
+    {
+      char *srcp = (char *)__upc_sptr_to_addr (src);
+      size_t p_offset = GUPCR_PTS_OFFSET (src) & GUPCR_VM_OFFSET_MASK;
+      size_t n_copy = GUPCR_MIN (GUPCR_VM_PAGE_SIZE - p_offset, n);
+      __upc_nb_offload (UPC_NB_OP_COPY, dest, srcp, 0, n_copy, counter);
+      n -= n_copy;
+      if (!n)
+	break;
+      GUPCR_PTS_INCR_VADDR (src, n_copy);
+      dest = (char *) dest + n_copy;
+    }
+  return handle;
+}
+
+unsigned long
+__upc_nb_put (upc_shared_ptr_t dest, const void *src, size_t n, int implicit)
+{
+  unsigned long handle;
+  os_atomic_p counter;
+  if (!__upc_nb_offload_p (n)
+      || !(counter = __upc_nb_counter (implicit, &handle)))
+    {
+      __upc_memput (dest, src, n);
+      return 0;
+    }
+  if (!src)
+    __upc_fatal ("Invalid access via null shared pointer");
+  if (GUPCR_PTS_IS_NULL (dest))
+    __upc_fatal ("Invalid access via null shared pointer");
+  for (;;)
+    {
+      char *destp = (char *)__upc_sptr_to_addr (dest);
+      size_t p_offset = GUPCR_PTS_OFFSET (dest) & GUPCR_VM_OFFSET_MASK;
+      size_t n_copy = GUPCR_MIN (GUPCR_VM_PAGE_SIZE - p_offset, n);
+      __upc_nb_offload (UPC_NB_OP_COPY, destp, src, 0, n_copy, counter);
+      n -= n_copy;
+      if (!n)
+	break;
+      GUPCR_PTS_INCR_VADDR (dest, n_copy);
+      src = (const char *) src + n_copy;
+    }
+  return handle;
+}
+
+unsigned long
+__upc_nb_set (upc_shared_ptr_t dest, int c, size_t n, int implicit)
+{
+  unsigned long handle;
+  os_atomic_p counter;
+  if (!__upc_nb_offload_p (n)
+      || !(counter = __upc_nb_counter (implicit, &handle)))
+    {
+      __upc_memset (dest, c, n);
+      return 0;
+    }
+  if (GUPCR_PTS_IS_NULL (dest))
+    __upc_fatal ("Invalid access via null shared pointer");
+  for (;;)
+    {
+      char *destp = (char *)__upc_sptr_to_addr (dest);
+      size_t p_offset = GUPCR_PTS_OFFSET (dest) & GUPCR_VM_OFFSET_MASK;
+      size_t n_set = GUPCR_MIN (GUPCR_VM_PAGE_SIZE - p_offset, n);
+      __upc_nb_offload (UPC_NB_OP_SET, destp, NULL, c, n_set, counter);
+      n -= n_set;
+      if (!n)
+	break;
+      GUPCR_PTS_INCR_VADDR (dest, n_set);
+    }
+  return handle;
+}
+
+/* Return TRUE if the explicit handle transfer has completed,
+   in which case its handle is released.  Otherwise, execute
+   one queued segment and check again.  */
+
+int
+__upc_nb_completed (unsigned long handle)
+{
+  upc_nb_req_p r;
+  if (!handle)
+    return 1;
+  r = __upc_nb_req_lookup (handle);
+  if (r->pending)
+    (void) __upc_nb_progress ();
+  if (r->pending)
+    return 0;
+  GUPCR_READ_FENCE ();
+  r->handle = 0;
+  return 1;
+}
+
+void
+__upc_nb_sync (unsigned long handle)
+{
+  upc_nb_req_p r;
+  if (!handle)
+    return;
+  r = __upc_nb_req_lookup (handle);
+  __upc_nb_wait (&r->pending);
+  r->handle = 0;
+}
+
+int
+__upc_nbi_completed (void)
+{
+  if (__upc_nbi_pending)
+    (void) __upc_nb_progress ();
+  if (__upc_nbi_pending)
+    return 0;
+  GUPCR_READ_FENCE ();
+  return 1;
+}
+
+void
+__upc_nbi_sync (void)
+{
+  __upc_nb_wait (&__upc_nbi_pending);
+}
+
+int
+__upc_nb_progress (void)
+{
+  upc_nb_seg_p seg;
+  if (!__upc_nb_queue_head)
+    return 0;
+  pthread_mutex_lock (&__upc_nb_mutex);
+  seg = __upc_nb_dequeue ();
+  pthread_mutex_unlock (&__upc_nb_mutex);
+  if (!seg)
+    return 0;
+  __upc_nb_execute (seg);
+  return 1;
+}
+
+void
+__upc_nb_quiesce (void)
+{
+  __upc_nb_wait (&__upc_nb_outstanding);
+}
@@ -0,0 +1,44 @@
+/*===-- upc_nb_sup.h - UPC Runtime Support Library -----------------------===
+|*
+|*                     The LLVM Compiler Infrastructure
+|*
+|* Copyright 2014, Intrepid Technology, Inc.  All rights reserved.
+|* This file is distributed under a BSD-style Open Source License.
+|* See LICENSE-INTREPID.TXT for details.
+|*
+|*===---------------------------------------------------------------------===*/
+
+#ifndef _UPC_NB_SUP_H_
+#define _UPC_NB_SUP_H_
+
+/* SMP non-blocking transfer support routines.
+
+   Transfer handles are unsigned long values; zero
+   (UPC_COMPLETE_HANDLE) denotes a transfer that has
+   already completed.  The 'implicit' argument selects
+   an implicit handle (nbi) transfer, in which case
+   zero is always returned.  */
+
+extern unsigned long __upc_nb_copy (upc_shared_ptr_t, upc_shared_ptr_t,
+				    size_t, int implicit);
+extern unsigned long __upc_nb_get (void *, upc_shared_ptr_t,
+				   size_t, int implicit);
+extern unsigned long __upc_nb_put (upc_shared_ptr_t, const void *,
+				   size_t, int implicit);
+extern unsigned long __upc_nb_set (upc_shared_ptr_t, int,
+				   size_t, int implicit);
+extern int __upc_nb_completed (unsigned long);
+extern void __upc_nb_sync (unsigned long);
+extern int __upc_nbi_completed (void);
+extern void __upc_nbi_sync (void);
+
+/* Execute one queued transfer segment on behalf of the
+   offload engine.  Returns non-zero if work was done.  */
+extern int __upc_nb_progress (void);
+
+/* Wait until all transfers issued by the calling thread
+   have completed.  Called before the VM layer unmaps
+   a page that queued transfers may still refer to.  */
+extern void __upc_nb_quiesce (void);
+
+#endif /* _UPC_NB_SUP_H_ */
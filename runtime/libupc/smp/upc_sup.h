@@ -60,6 +60,8 @@ extern void __upc_validate_pgm_info (char *);
 extern void __upc_vm_init_per_thread (void);
 extern void __upc_vm_init (upc_page_num_t);
 extern void __upc_barrier_init (void);
+extern int __upc_barrier_get_fanout (void);
+extern int __upc_barrier_get_domain (int);
 
 //begin lib_sptr_to_addr
 
@@ -14,6 +14,7 @@
 #include "upc_sup.h"
 #include "upc_sync.h"
 #include "upc_numa.h"
+#include "upc_nb_sup.h"
 
 /* There is a local page table for each thread. The
    local page table maps a local page to the location
@@ -188,9 +189,12 @@ __upc_vm_map_global_page (int t, upc_page_num_t p)
     }
   if (i == GUPCR_VM_GLOGAl_MAP_SET_SIZE)
     {
-      /* The set is full.  Unmap the last entry. */
+      /* The set is full.  Unmap the last entry, once any
+         queued non-blocking transfers that may refer to it
+         have completed.  */
       g = &(*s)[GUPCR_VM_GLOGAl_MAP_SET_SIZE - 1];
       page_base = g->local_page;
+      __upc_nb_quiesce ();
       if (munmap (page_base, GUPCR_VM_PAGE_SIZE))
         { perror ("UPC runtime error: global unmap"); abort (); }
       /* Decrement 'i' so that it points to the last entry. */